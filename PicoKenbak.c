@@ -1,5 +1,6 @@
 #include "pico/stdlib.h"
 #include "processor.h"
+#include "remotepanel.h"
 
 #define ADDRESS_DISPLAY_BUTTON 10
 #define ADDRESS_SET_BUTTON 11
@@ -15,64 +16,22 @@
 
 void execute() {
     PROGRAM_COUNTER_VALUE = 0x4;
-    while (gpio_get(STOP_BUTTON)) {
-        uint8_t instruction = memory[PROGRAM_COUNTER_VALUE++];
-        if (instruction == 0) {
-            return;
-        }
-        if ((instruction & 0b111) == 02) {
-            set(instruction);
-            continue;
+    uint32_t instructionsExecuted = 0;
+    uint8_t lastOutput = memory[OUTPUT_REGISTER_ADDRESS];
+    while (gpio_get(STOP_BUTTON) && !remotePanelTakeButtonPress(REMOTE_PANEL_STOP_BUTTON_INDEX)) {
+        // The panel is only sampled every so often, so the host doesn't slow us down
+        if ((++instructionsExecuted & (REMOTE_PANEL_SERVICE_INTERVAL - 1)) == 0) {
+            remotePanelService();
         }
-        else if ((instruction & 0b111) == 01) {
-            switch (((instruction & 0xE0) >> 5)) {
-                case 0:
-                case 1:
-                case 2:
-                case 3:
-                    shiftRotate(instruction);
-            }
-            continue;
+
+        if (!step()) {
+            return;
         }
-        switch (((instruction & 0b00111000) >> 3)) {
-            case 00:
-                if (((instruction & 0xE0) >> 5) == 03) {
-                    logicalOr(instruction);
-                }
-                else {
-                    add(instruction);
-                }
-                break;
-            case 01:
-                if (((instruction & 0xE0) >> 5) == 03) {
-                    nop();
-                }
-                else {
-                    sub(instruction);
-                }
-                break;
-            case 02:
-                if (((instruction & 0xE0) >> 5) == 03) {
-                    logicalAnd(instruction);
-                }
-                else {
-                    load(instruction);
-                }
-                break;
-            case 03:
-                if (((instruction & 0xE0) >> 5) == 03) {
-                    loadComplement(instruction);
-                }
-                else {
-                    store(instruction);
-                }
-                break;
-            case 04:
-            case 05:
-            case 06:
-            case 07:
-                jump(instruction);
-                break;
+
+        // OUTPUT can change faster than the sampling above, so catch every change to it
+        if (memory[OUTPUT_REGISTER_ADDRESS] != lastOutput) {
+            lastOutput = memory[OUTPUT_REGISTER_ADDRESS];
+            remotePanelUpdate();
         }
     }
     // Quick hack for more accurate timing (The KENBAK-1 averaged <1000 instructions per second)
@@ -107,6 +66,8 @@ void setControlLamps(uint8_t lampToLightUp) {
             gpio_put(controlLampPins[i], 0);
         }
     }
+
+    remotePanelSetControlLamp(lampToLightUp);
 }
 
 int main() {
@@ -159,10 +120,13 @@ int main() {
     setControlLamps(lampToLightUp);
 
     for(;;) {
+        // Button presses from a remote viewer are picked up here and handled like the real ones
+        remotePanelService();
+
         for (int i = 0; i < sizeof(pushButtonPins)/sizeof(uint8_t); ++i) {
             uint8_t button = pushButtonPins[i];
             // The buttons are pulled up, so we need to reverse the read
-            currentPushButtonPinStates[i] = !gpio_get(button);
+            currentPushButtonPinStates[i] = !gpio_get(button) || remotePanelTakeButtonPress(i);
 
             // Check if the button press is new
             uint8_t isStateNew = 0;
@@ -202,6 +166,8 @@ int main() {
                         setControlLamps(lampToLightUp);
                         // STOP_BUTTON is handled inside here
                         execute();
+                        // Real buttons other than stop do nothing while running, so remote ones shouldn't either
+                        remotePanelClearButtonPresses();
                         lampToLightUp = ALL_LAMPS_OFF;
                         setControlLamps(lampToLightUp);
                         break;
@@ -210,24 +176,27 @@ int main() {
                         setControlLamps(lampToLightUp);
                         break;
                 }
+                uint8_t displayedByte = 0;
                 for (int j = 0; j < 8; ++j) {
                     if (lampToLightUp == INPUT_LAMP) {
-                        gpio_put(LEDPins[j], getBit(memory[INPUT_REGISTER_ADDRESS], j));
+                        setBit(&displayedByte, j, getBit(memory[INPUT_REGISTER_ADDRESS], j));
                     }
                     if (lampToLightUp == ADDRESS_LAMP) {
-                        gpio_put(LEDPins[j], getBit(memory[P_REGISTER_ADDRESS], j));
+                        setBit(&displayedByte, j, getBit(memory[P_REGISTER_ADDRESS], j));
                     }
                     if (lampToLightUp == MEMORY_LAMP) {
-                        gpio_put(LEDPins[j], getBit(memory[memory[P_REGISTER_ADDRESS]], j));
+                        setBit(&displayedByte, j, getBit(memory[memory[P_REGISTER_ADDRESS]], j));
                         if (j == 7) {
                             ++(memory[P_REGISTER_ADDRESS]);
                         }
                     }
                     if (lampToLightUp == ALL_LAMPS_OFF) {
-                        gpio_put(LEDPins[j], getBit(memory[OUTPUT_REGISTER_ADDRESS], j));
+                        setBit(&displayedByte, j, getBit(memory[OUTPUT_REGISTER_ADDRESS], j));
                     }
                     // RUN_LAMP is never on when here, so we don't need to check for it.
+                    gpio_put(LEDPins[j], getBit(displayedByte, j));
                 }
+                remotePanelSetDataLamps(displayedByte);
             }
             pushButtonPinStates[i] = currentPushButtonPinStates[i];
         }
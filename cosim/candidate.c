@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include "processor.h"
+#include "candidate.h"
+
+/*
+ * Decodes every opcode once up front and dispatches through a table,
+ * instead of going through the chain of checks in step() for every instruction.
+ * Replace this with whatever engine needs to be checked.
+ */
+
+typedef void (*InstructionHandler)(uint8_t instruction);
+
+static InstructionHandler handlers[256];
+
+// Some opcodes don't do anything apart from moving past themselves
+static void ignore(uint8_t instruction) {
+}
+
+static void callNop(uint8_t instruction) {
+    nop();
+}
+
+static InstructionHandler decode(uint8_t instruction) {
+    uint8_t mostSignificant3bits = (instruction & 0xE0) >> 5;
+
+    if ((instruction & 0b111) == 02) {
+        return set;
+    }
+    if ((instruction & 0b111) == 01) {
+        return (mostSignificant3bits <= 3) ? shiftRotate : ignore;
+    }
+    switch ((instruction & 0b00111000) >> 3) {
+        case 00:
+            return (mostSignificant3bits == 03) ? logicalOr : add;
+        case 01:
+            return (mostSignificant3bits == 03) ? callNop : sub;
+        case 02:
+            return (mostSignificant3bits == 03) ? logicalAnd : load;
+        case 03:
+            return (mostSignificant3bits == 03) ? loadComplement : store;
+        default:
+            return jump;
+    }
+}
+
+uint8_t candidateStep() {
+    static uint8_t initialized = 0;
+
+    if (!initialized) {
+        for (int i = 0; i < 256; ++i) {
+            handlers[i] = decode(i);
+        }
+        initialized = 1;
+    }
+
+    uint8_t instruction = memory[PROGRAM_COUNTER_VALUE++];
+    if (instruction == 0) {
+        return 0;
+    }
+    handlers[instruction](instruction);
+    return 1;
+}
@@ -0,0 +1,11 @@
+#include <stdint.h>
+
+#ifndef PICOKENBAK_CANDIDATE_H
+#define PICOKENBAK_CANDIDATE_H
+
+/*
+ * The execution engine under test. It must behave exactly like step() in processor.c:
+ * execute the instruction P points to, and return 0 if it was a halt.
+ */
+uint8_t candidateStep();
+#endif //PICOKENBAK_CANDIDATE_H
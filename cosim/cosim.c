@@ -0,0 +1,311 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "processor.h"
+#include "candidate.h"
+
+/*
+ * Lockstep differential co-simulation.
+ * Runs the reference engine (step() from processor.c) and the candidate engine on the same programs,
+ * comparing state hashes every few instructions. On the first divergence it steps back through the last
+ * few instructions to find the exact one, shrinks the memory image down to what's needed to reproduce it,
+ * prints it and writes it out as a corpus file.
+ *
+ * Usage: cosim [-i total instructions] [-n instructions between checks] [-b instructions per program]
+ *              [-s seed] [-o reproducer file] [-r] [corpus files...]
+ * Corpus files are raw memory images loaded at address 0. They run first, then random programs.
+ * P is set to 0x4 like pressing start does, unless -r is given. Use -r to rerun a reproducer,
+ * which holds the state right before the diverging instruction: cosim -r -i 0 divergence.bin
+ */
+
+typedef uint8_t (*Engine)();
+
+static const char *reproducerPath = "divergence.bin";
+static uint8_t keepProgramCounter = 0;
+
+typedef struct {
+    uint8_t memory[256];
+    uint8_t halted;
+} MachineState;
+
+static uint64_t randomState;
+
+static uint64_t nextRandom() {
+    // xorshift64*
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64_t hashState(const MachineState *state) {
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < sizeof(state->memory); ++i) {
+        hash = (hash ^ state->memory[i]) * 0x100000001B3ULL;
+    }
+    return (hash ^ state->halted) * 0x100000001B3ULL;
+}
+
+static uint8_t statesMatch(const MachineState *a, const MachineState *b) {
+    return a->halted == b->halted && memcmp(a->memory, b->memory, sizeof(a->memory)) == 0;
+}
+
+// Both engines work on the global memory, so each one gets its state swapped in and out around a run
+static uint64_t run(Engine engine, MachineState *state, uint64_t count) {
+    uint64_t executed = 0;
+
+    if (state->halted) {
+        return 0;
+    }
+
+    memcpy(memory, state->memory, sizeof(memory));
+    while (executed < count) {
+        ++executed;
+        if (!engine()) {
+            state->halted = 1;
+            break;
+        }
+    }
+    memcpy(state->memory, memory, sizeof(memory));
+
+    return executed;
+}
+
+static uint8_t divergesInOneStep(const MachineState *before) {
+    MachineState reference = *before;
+    MachineState candidate = *before;
+
+    run(step, &reference, 1);
+    run(candidateStep, &candidate, 1);
+
+    return !statesMatch(&reference, &candidate);
+}
+
+/*
+ * The engines agree at checkpoint and disagree at most interval instructions later.
+ * Step both one instruction at a time to find how many they still agree on.
+ * The states can match again after a wrong write gets overwritten, so this has to go forwards from the checkpoint.
+ */
+static uint64_t findFirstDivergence(const MachineState *checkpoint, uint64_t interval) {
+    MachineState reference = *checkpoint;
+    MachineState candidate = *checkpoint;
+    uint64_t agreeing = 0;
+
+    while (agreeing < interval) {
+        run(step, &reference, 1);
+        run(candidateStep, &candidate, 1);
+        if (!statesMatch(&reference, &candidate)) {
+            break;
+        }
+        ++agreeing;
+    }
+
+    return agreeing;
+}
+
+/*
+ * Zero out every byte that isn't needed for the divergence to happen.
+ * P, the instruction and its operand are kept, so the reproducer still runs the instruction that was reported.
+ */
+static void minimise(MachineState *state) {
+    uint8_t p = state->memory[P_REGISTER_ADDRESS];
+
+    for (int i = 0; i < sizeof(state->memory); ++i) {
+        uint8_t original = state->memory[i];
+        if (original == 0 || i == P_REGISTER_ADDRESS || i == p || i == (uint8_t)(p + 1)) {
+            continue;
+        }
+        state->memory[i] = 0;
+        if (!divergesInOneStep(state)) {
+            state->memory[i] = original;
+        }
+    }
+}
+
+static void printDifferences(const MachineState *reference, const MachineState *candidate) {
+    if (reference->halted != candidate->halted) {
+        printf("  halted: reference %d, candidate %d\n", reference->halted, candidate->halted);
+    }
+    for (int i = 0; i < sizeof(reference->memory); ++i) {
+        if (reference->memory[i] != candidate->memory[i]) {
+            printf("  0x%02X: reference 0x%02X, candidate 0x%02X\n", i, reference->memory[i], candidate->memory[i]);
+        }
+    }
+}
+
+static void reportDivergence(const char *programName, uint64_t instructionsIntoProgram, MachineState *before) {
+    MachineState reference = *before;
+    MachineState candidate = *before;
+    uint8_t p = before->memory[P_REGISTER_ADDRESS];
+
+    printf("Divergence in %s at instruction %llu\n", programName, (unsigned long long)instructionsIntoProgram + 1);
+    printf("P = 0x%02X, instruction 0x%02X, operand 0x%02X\n", p, before->memory[p], before->memory[(uint8_t)(p + 1)]);
+
+    minimise(before);
+    printf("Minimised reproducer, memory before the instruction (every other byte is 0):\n");
+    for (int i = 0; i < sizeof(before->memory); ++i) {
+        if (before->memory[i] != 0) {
+            printf("  0x%02X: 0x%02X\n", i, before->memory[i]);
+        }
+    }
+
+    reference = *before;
+    candidate = *before;
+    run(step, &reference, 1);
+    run(candidateStep, &candidate, 1);
+    printf("After one instruction:\n");
+    printDifferences(&reference, &candidate);
+
+    FILE *file = fopen(reproducerPath, "wb");
+    if (!file || fwrite(before->memory, 1, sizeof(before->memory), file) != sizeof(before->memory)) {
+        perror(reproducerPath);
+    }
+    else {
+        printf("Reproducer written to %s, rerun it with -r -i 0 %s\n", reproducerPath, reproducerPath);
+    }
+    if (file) {
+        fclose(file);
+    }
+}
+
+/*
+ * Runs one program on both engines until both halt or budget runs out.
+ * Returns the number of instructions executed, or -1 if the engines diverged.
+ */
+static int64_t runProgram(const char *programName, const MachineState *initial, uint64_t budget, uint64_t interval) {
+    MachineState reference = *initial;
+    MachineState candidate = *initial;
+    MachineState checkpoint;
+    uint64_t executed = 0;
+
+    while (executed < budget && !(reference.halted && candidate.halted)) {
+        uint64_t chunk = budget - executed < interval ? budget - executed : interval;
+
+        checkpoint = reference;
+        uint64_t executedByReference = run(step, &reference, chunk);
+        run(candidateStep, &candidate, chunk);
+
+        if (hashState(&reference) != hashState(&candidate)) {
+            uint64_t agreeing = findFirstDivergence(&checkpoint, chunk);
+            run(step, &checkpoint, agreeing);
+            reportDivergence(programName, executed + agreeing, &checkpoint);
+            return -1;
+        }
+
+        executed += executedByReference;
+    }
+
+    return executed;
+}
+
+static uint8_t loadCorpusProgram(const char *path, MachineState *state) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+
+    memset(state, 0, sizeof(*state));
+    fread(state->memory, 1, sizeof(state->memory), file);
+    fclose(file);
+
+    // Same as pressing start on the board
+    if (!keepProgramCounter) {
+        state->memory[P_REGISTER_ADDRESS] = 0x4;
+    }
+    return 1;
+}
+
+static void generateRandomProgram(MachineState *state) {
+    memset(state, 0, sizeof(*state));
+    for (int i = 0; i < sizeof(state->memory); i += 8) {
+        uint64_t randomBytes = nextRandom();
+        memcpy(&state->memory[i], &randomBytes, 8);
+    }
+    state->memory[P_REGISTER_ADDRESS] = 0x4;
+}
+
+int main(int argc, char **argv) {
+    uint64_t totalInstructions = 100000000;
+    uint64_t interval = 1024;
+    uint64_t budgetPerProgram = 100000;
+    uint64_t seed = (uint64_t)time(NULL);
+    int option;
+
+    while ((option = getopt(argc, argv, "i:n:b:s:o:r")) != -1) {
+        switch (option) {
+            case 'i':
+                totalInstructions = strtoull(optarg, NULL, 0);
+                break;
+            case 'n':
+                interval = strtoull(optarg, NULL, 0);
+                break;
+            case 'b':
+                budgetPerProgram = strtoull(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'o':
+                reproducerPath = optarg;
+                break;
+            case 'r':
+                keepProgramCounter = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-i total instructions] [-n instructions between checks] "
+                                "[-b instructions per program] [-s seed] [-o reproducer file] [-r] [corpus files...]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (interval == 0 || budgetPerProgram == 0) {
+        fprintf(stderr, "-n and -b must be greater than 0\n");
+        return 2;
+    }
+
+    // xorshift gets stuck at 0
+    randomState = seed ? seed : 1;
+    printf("Seed %llu\n", (unsigned long long)seed);
+
+    MachineState initial;
+    uint64_t executed = 0;
+    uint64_t programs = 0;
+    clock_t startTime = clock();
+
+    for (int i = optind; i < argc; ++i) {
+        if (!loadCorpusProgram(argv[i], &initial)) {
+            return 2;
+        }
+        int64_t result = runProgram(argv[i], &initial, budgetPerProgram, interval);
+        if (result < 0) {
+            return 1;
+        }
+        executed += result;
+        ++programs;
+    }
+
+    while (executed < totalInstructions) {
+        char programName[64];
+        snprintf(programName, sizeof(programName), "random program %llu", (unsigned long long)programs);
+
+        generateRandomProgram(&initial);
+        int64_t result = runProgram(programName, &initial, budgetPerProgram, interval);
+        if (result < 0) {
+            printf("Rerun with -s %llu to reproduce\n", (unsigned long long)seed);
+            return 1;
+        }
+        executed += result;
+        ++programs;
+    }
+
+    double seconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    printf("%llu instructions in %llu programs, no divergence (%.0f instructions per second)\n",
+           (unsigned long long)executed, (unsigned long long)programs, seconds > 0 ? executed / seconds : 0);
+
+    return 0;
+}
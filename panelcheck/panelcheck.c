@@ -0,0 +1,219 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "panelencoder.h"
+
+/*
+ * Checks the remote panel encoder on a host.
+ * Feeds it random panel states while draining the buffer by random amounts, decodes what comes out
+ * the way a viewer would, and makes sure the viewer ends up with the same state as the board.
+ *
+ * Usage: panelcheck [iterations] [seed]
+ */
+
+static uint64_t randomState;
+
+static uint64_t nextRandom() {
+    // xorshift64*
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 0x2545F4914F6CDD1DULL;
+}
+
+// What a viewer keeps track of
+static uint8_t stream[1 << 16];
+static uint32_t received = 0;
+static uint32_t decoded = 0;
+static uint8_t viewerState[REMOTE_PANEL_FIELD_COUNT];
+static uint8_t viewerHasKeyframe = 0;
+static uint8_t viewerLastMask = 0;
+static uint8_t viewerLastDeltas[REMOTE_PANEL_FIELD_COUNT];
+
+static uint64_t iteration = 0;
+
+static void fail(const char *message) {
+    printf("Iteration %llu: %s\n", (unsigned long long)iteration, message);
+    exit(1);
+}
+
+static void resetViewer() {
+    received = decoded = 0;
+    viewerHasKeyframe = 0;
+    viewerLastMask = 0;
+}
+
+static void applyDeltas(uint8_t mask, const uint8_t *deltas) {
+    for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+        if (mask & (1 << i)) {
+            viewerState[i] += deltas[i];
+        }
+    }
+}
+
+// Decodes every whole record received so far
+static void decode() {
+    while (decoded < received) {
+        uint8_t header = stream[decoded];
+        uint32_t length = 1;
+
+        if (header == REMOTE_PANEL_KEYFRAME) {
+            length += REMOTE_PANEL_FIELD_COUNT;
+        }
+        else if (!(header & REMOTE_PANEL_REPEAT)) {
+            if (header == 0 || header >= (1 << REMOTE_PANEL_FIELD_COUNT)) {
+                fail("invalid record header");
+            }
+            for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+                length += (header >> i) & 1;
+            }
+        }
+        if (received - decoded < length) {
+            return;
+        }
+
+        if (header == REMOTE_PANEL_KEYFRAME) {
+            memcpy(viewerState, &stream[decoded + 1], REMOTE_PANEL_FIELD_COUNT);
+            viewerHasKeyframe = 1;
+            viewerLastMask = 0;
+        }
+        else if (!viewerHasKeyframe) {
+            fail("record before the first keyframe");
+        }
+        else if (header & REMOTE_PANEL_REPEAT) {
+            if (!viewerLastMask) {
+                fail("repeat without a delta record before it");
+            }
+            for (int count = header & REMOTE_PANEL_REPEAT_MAX; count > 0; --count) {
+                applyDeltas(viewerLastMask, viewerLastDeltas);
+            }
+        }
+        else {
+            const uint8_t *bytes = &stream[decoded + 1];
+            for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+                viewerLastDeltas[i] = (header & (1 << i)) ? *bytes++ : 0;
+            }
+            viewerLastMask = header;
+            applyDeltas(viewerLastMask, viewerLastDeltas);
+        }
+        decoded += length;
+    }
+
+    // Keep the stream buffer from running out, whatever is decoded isn't needed anymore
+    if (decoded == received) {
+        received = decoded = 0;
+    }
+}
+
+// Takes up to limit bytes from the encoder, in at most two pieces like remotePanelFlush()
+static void drain(uint32_t limit) {
+    for (int segment = 0; segment < 2; ++segment) {
+        const uint8_t *data;
+        uint32_t length = panelEncoderPending(&data);
+        if (length > limit) {
+            length = limit;
+        }
+        if (length == 0) {
+            break;
+        }
+        if (received + length > sizeof(stream)) {
+            fail("viewer stream buffer overflow");
+        }
+        memcpy(&stream[received], data, length);
+        received += length;
+        panelEncoderConsume(length);
+        limit -= length;
+    }
+    decode();
+}
+
+static void drainAll() {
+    drain(REMOTE_PANEL_BUFFER_SIZE);
+    drain(REMOTE_PANEL_BUFFER_SIZE);
+}
+
+// Once the host has caught up, it must have the latest state and no half received record
+static void checkSettled(const uint8_t *state) {
+    drainAll();
+    panelEncoderUpdate(state);
+    drainAll();
+
+    if (decoded != received) {
+        fail("half a record left over after draining everything");
+    }
+    if (memcmp(viewerState, state, REMOTE_PANEL_FIELD_COUNT) != 0) {
+        fail("viewer state differs from the board");
+    }
+}
+
+int main(int argc, char **argv) {
+    uint64_t iterations = argc > 1 ? strtoull(argv[1], NULL, 0) : 2000000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 1;
+    uint8_t state[REMOTE_PANEL_FIELD_COUNT] = {0};
+
+    // xorshift gets stuck at 0
+    randomState = seed ? seed : 1;
+
+    panelEncoderStart(state, 0);
+
+    for (iteration = 0; iteration < iterations; ++iteration) {
+        uint64_t choice = nextRandom();
+
+        switch (choice % 8) {
+            case 0:
+            case 1:
+            case 2:
+                // A running program, mostly P moving the same amount, which run-length encodes
+                state[REMOTE_PANEL_FIELD_P] += 2;
+                break;
+            case 3:
+                state[REMOTE_PANEL_FIELD_P] += (nextRandom() % 4) + 1;
+                break;
+            case 4:
+                state[REMOTE_PANEL_FIELD_OUTPUT] = nextRandom();
+                break;
+            case 5:
+                state[nextRandom() % REMOTE_PANEL_FIELD_COUNT] = nextRandom();
+                break;
+            default:
+                // Nothing changed
+                break;
+        }
+        panelEncoderUpdate(state);
+
+        // The host sometimes keeps up and sometimes falls far behind, so the buffer fills and wraps
+        switch ((choice >> 8) % 4) {
+            case 0:
+                drain(nextRandom() % 64);
+                break;
+            case 1:
+                drain(nextRandom() % 4);
+                break;
+            default:
+                break;
+        }
+
+        switch ((choice >> 16) % 4096) {
+            case 0:
+                // Hello again from the same viewer, in the middle of the stream
+                panelEncoderStart(state, 1);
+                break;
+            case 1:
+                // A new viewer, it only gets what is sent from now on
+                panelEncoderStart(state, 0);
+                resetViewer();
+                break;
+            case 2:
+            case 3:
+                checkSettled(state);
+                break;
+            default:
+                break;
+        }
+    }
+
+    checkSettled(state);
+    printf("%llu iterations, viewer always caught up with the board\n", (unsigned long long)iterations);
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <stdint.h>
+#include <string.h>
+#include "panelencoder.h"
+
+#define REMOTE_PANEL_BUFFER_MASK (REMOTE_PANEL_BUFFER_SIZE - 1)
+
+// Encoded bytes waiting to go out. head and tail run freely and are masked on access.
+static uint8_t buffer[REMOTE_PANEL_BUFFER_SIZE];
+static uint32_t head = 0;
+static uint32_t tail = 0;
+// Start of the record tail is in, so a restart can finish a record that is partly sent
+static uint32_t recordStart = 0;
+
+// What the host has been told so far, and the last delta record, so identical ones can be run-length encoded
+static uint8_t sentState[REMOTE_PANEL_FIELD_COUNT];
+static uint8_t lastMask = 0;
+static uint8_t lastDeltas[REMOTE_PANEL_FIELD_COUNT];
+// Position of the repeat byte that can still be incremented, only while it hasn't been sent
+static uint8_t repeatPending = 0;
+static uint32_t repeatPosition = 0;
+
+static uint32_t freeSpace() {
+    return REMOTE_PANEL_BUFFER_SIZE - (head - tail);
+}
+
+static void push(uint8_t byte) {
+    buffer[head++ & REMOTE_PANEL_BUFFER_MASK] = byte;
+}
+
+static uint32_t recordLength(uint32_t position) {
+    uint8_t header = buffer[position & REMOTE_PANEL_BUFFER_MASK];
+    uint32_t length = 1;
+
+    if (header == REMOTE_PANEL_KEYFRAME) {
+        return 1 + REMOTE_PANEL_FIELD_COUNT;
+    }
+    if (header & REMOTE_PANEL_REPEAT) {
+        return 1;
+    }
+    for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+        length += (header >> i) & 1;
+    }
+    return length;
+}
+
+/*
+ * Queues a keyframe. Everything not sent yet is dropped, since the keyframe describes it all.
+ * If the host is still listening to the same stream, keepPartialRecord keeps the rest of a record
+ * that has been partly sent, so the keyframe doesn't land in the middle of it.
+ */
+void panelEncoderStart(const uint8_t *state, uint8_t keepPartialRecord) {
+    if (keepPartialRecord && recordStart != tail) {
+        head = recordStart + recordLength(recordStart);
+    }
+    else {
+        head = tail = recordStart = 0;
+    }
+    repeatPending = 0;
+    lastMask = 0;
+
+    memcpy(sentState, state, sizeof(sentState));
+    push(REMOTE_PANEL_KEYFRAME);
+    for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+        push(sentState[i]);
+    }
+}
+
+/*
+ * Records how state changed since the last state that made it into the buffer.
+ * If the buffer is full the change is simply not recorded yet. sentState stays behind and the
+ * next call that finds room sends the combined delta, so the host always catches up to the latest state.
+ */
+void panelEncoderUpdate(const uint8_t *state) {
+    uint8_t deltas[REMOTE_PANEL_FIELD_COUNT];
+    uint8_t mask = 0;
+    uint8_t changedFields = 0;
+
+    for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+        deltas[i] = state[i] - sentState[i];
+        if (deltas[i]) {
+            mask |= 1 << i;
+            ++changedFields;
+        }
+    }
+
+    if (!mask) {
+        return;
+    }
+
+    if (mask == lastMask && memcmp(deltas, lastDeltas, sizeof(deltas)) == 0) {
+        if (repeatPending && buffer[repeatPosition & REMOTE_PANEL_BUFFER_MASK] < (REMOTE_PANEL_REPEAT | REMOTE_PANEL_REPEAT_MAX)) {
+            ++buffer[repeatPosition & REMOTE_PANEL_BUFFER_MASK];
+        }
+        else if (freeSpace() >= 1) {
+            repeatPending = 1;
+            repeatPosition = head;
+            push(REMOTE_PANEL_REPEAT | 1);
+        }
+        else {
+            return;
+        }
+    }
+    else {
+        if (freeSpace() < 1 + changedFields) {
+            return;
+        }
+        push(mask);
+        for (int i = 0; i < REMOTE_PANEL_FIELD_COUNT; ++i) {
+            if (deltas[i]) {
+                push(deltas[i]);
+            }
+        }
+        lastMask = mask;
+        memcpy(lastDeltas, deltas, sizeof(deltas));
+        repeatPending = 0;
+    }
+
+    memcpy(sentState, state, sizeof(sentState));
+}
+
+// Points data at the next bytes to send and returns how many there are, up to the end of the buffer
+uint32_t panelEncoderPending(const uint8_t **data) {
+    uint32_t position = tail & REMOTE_PANEL_BUFFER_MASK;
+    uint32_t length = head - tail;
+
+    if (length > REMOTE_PANEL_BUFFER_SIZE - position) {
+        length = REMOTE_PANEL_BUFFER_SIZE - position;
+    }
+    *data = &buffer[position];
+    return length;
+}
+
+void panelEncoderConsume(uint32_t count) {
+    tail += count;
+
+    while (recordStart != tail && tail - recordStart >= recordLength(recordStart)) {
+        recordStart += recordLength(recordStart);
+    }
+
+    // Once the repeat byte is gone it can't be incremented anymore
+    if (repeatPending && (int32_t)(repeatPosition - tail) < 0) {
+        repeatPending = 0;
+    }
+}
@@ -0,0 +1,31 @@
+#include <stdint.h>
+
+#ifndef PICOKENBAK_PANELENCODER_H
+#define PICOKENBAK_PANELENCODER_H
+
+/*
+ * Encoder for the remote front panel stream, see the README for the wire format.
+ * It only deals with bytes, so it builds on a host too.
+ */
+
+// Bytes the board sends to the host
+#define REMOTE_PANEL_KEYFRAME 0x40
+#define REMOTE_PANEL_REPEAT 0x80
+#define REMOTE_PANEL_REPEAT_MAX 0x7F
+
+// Order of the fields in a keyframe and of the bits in a delta record's mask
+#define REMOTE_PANEL_FIELD_DATA_LAMPS 0
+#define REMOTE_PANEL_FIELD_CONTROL_LAMP 1
+#define REMOTE_PANEL_FIELD_OUTPUT 2
+#define REMOTE_PANEL_FIELD_P 3
+#define REMOTE_PANEL_FIELD_COUNT 4
+
+// Must be a power of 2
+#define REMOTE_PANEL_BUFFER_SIZE 512
+
+void panelEncoderStart(const uint8_t *state, uint8_t keepPartialRecord);
+void panelEncoderUpdate(const uint8_t *state);
+
+uint32_t panelEncoderPending(const uint8_t **data);
+void panelEncoderConsume(uint32_t count);
+#endif //PICOKENBAK_PANELENCODER_H
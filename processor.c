@@ -3,9 +3,10 @@
 //
 
 #include <stdint.h>
-#include <pico/printf.h>
 #include "processor.h"
 
+uint8_t memory[256];
+
 uint8_t getBit(uint8_t byte, uint8_t bitToGet) {
     return (byte >> bitToGet) & 1;
 }
@@ -27,10 +28,11 @@ uint8_t fetchRealOperand(AddressingMode addressingMode, uint8_t operand) {
             return memory[operand];
         case ADDRESSING_MODE_INDIRECT:
             return memory[memory[operand]];
+        // Addresses wrap around, like on the real machine
         case ADDRESSING_MODE_INDEXED:
-            return memory[operand + memory[X_REGISTER_ADDRESS]];
+            return memory[(uint8_t)(operand + memory[X_REGISTER_ADDRESS])];
         case ADDRESSING_MODE_INDIRECT_INDEXED:
-            return memory[memory[operand] + memory[X_REGISTER_ADDRESS]];
+            return memory[(uint8_t)(memory[operand] + memory[X_REGISTER_ADDRESS])];
         default:
             break;
     }
@@ -79,7 +81,6 @@ void add(uint8_t instruction) {
     uint8_t operand = memory[PROGRAM_COUNTER_VALUE++];
 
     uint8_t numberToAdd = fetchRealOperand(addressingMode, operand);
-    printf("Adding %d to %d", registerToAddTo, memory[registerToAddTo]);
     uint16_t result = memory[registerToAddTo] + numberToAdd;
 
     memory[registerToAddTo] += numberToAdd;
@@ -87,8 +88,6 @@ void add(uint8_t instruction) {
     // The Overflow and Carry address for a register can be found by adding 0x81
     setBit(&memory[registerToAddTo + 0x81], CARRY_BIT, result > 0xFF);
     setBit(&memory[registerToAddTo + 0x81], OVERFLOW_BIT, result > 0x7F);
-
-    printf("0x%X is now %d from addition\n", registerToAddTo, memory[registerToAddTo]);
 }
 
 void sub(uint8_t instruction) {
@@ -115,7 +114,6 @@ void load(uint8_t instruction) {
     uint8_t valueToLoad = fetchRealOperand(addressingMode, operand);
 
     memory[registerToLoadTo] = valueToLoad;
-    printf("0x%X is now %d\n", registerToLoadTo, memory[registerToLoadTo]);
 }
 
 void store(uint8_t instruction) {
@@ -126,8 +124,6 @@ void store(uint8_t instruction) {
     uint8_t addressOfValueToStore = fetchRealOperand(addressingMode, operand);
 
     memory[addressOfValueToStore] = memory[registerToStore];
-
-    printf("0x%X is now %d\n", addressOfValueToStore, memory[addressOfValueToStore]);
 }
 
 void logicalAnd(uint8_t instruction) {
@@ -222,10 +218,8 @@ JumpCondition getJumpCondition(uint8_t instruction) {
 }
 
 void jump(uint8_t instruction) {
-    printf("Instruction: 0x%X", instruction);
     uint8_t operand = memory[PROGRAM_COUNTER_VALUE++];
     uint8_t addressToJumpTo = operand;
-    printf("Operand is %d\n", addressToJumpTo);
 
     uint8_t registerToCheck = getRegisterToCheckForJump(instruction);
     JumpCondition condition = getJumpCondition(instruction);
@@ -365,3 +359,66 @@ void shiftRotate(uint8_t instruction) {
 void nop() {
     ++PROGRAM_COUNTER_VALUE;
 }
+
+// Executes the instruction P points to. Returns 0 if it was a halt.
+uint8_t step() {
+    uint8_t instruction = memory[PROGRAM_COUNTER_VALUE++];
+    if (instruction == 0) {
+        return 0;
+    }
+    if ((instruction & 0b111) == 02) {
+        set(instruction);
+        return 1;
+    }
+    else if ((instruction & 0b111) == 01) {
+        switch (((instruction & 0xE0) >> 5)) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                shiftRotate(instruction);
+        }
+        return 1;
+    }
+    switch (((instruction & 0b00111000) >> 3)) {
+        case 00:
+            if (((instruction & 0xE0) >> 5) == 03) {
+                logicalOr(instruction);
+            }
+            else {
+                add(instruction);
+            }
+            break;
+        case 01:
+            if (((instruction & 0xE0) >> 5) == 03) {
+                nop();
+            }
+            else {
+                sub(instruction);
+            }
+            break;
+        case 02:
+            if (((instruction & 0xE0) >> 5) == 03) {
+                logicalAnd(instruction);
+            }
+            else {
+                load(instruction);
+            }
+            break;
+        case 03:
+            if (((instruction & 0xE0) >> 5) == 03) {
+                loadComplement(instruction);
+            }
+            else {
+                store(instruction);
+            }
+            break;
+        case 04:
+        case 05:
+        case 06:
+        case 07:
+            jump(instruction);
+            break;
+    }
+    return 1;
+}
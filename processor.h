@@ -38,7 +38,7 @@ typedef enum {
     JUMP_CONDITION_UNCONDITIONAL
 }JumpCondition;
 
-uint8_t memory[256];
+extern uint8_t memory[256];
 
 uint8_t determineRegisterToUse(uint8_t instruction);
 AddressingMode determineAddressingMode(uint8_t instruction);
@@ -74,4 +74,6 @@ void set(uint8_t instruction);
 void shiftRotate(uint8_t instruction);
 
 void nop();
+
+uint8_t step();
 #endif //PICOKENBAK_PROCESSOR_H
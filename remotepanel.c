@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#include "processor.h"
+#include "panelencoder.h"
+#include "remotepanel.h"
+
+static uint8_t active = 0;
+
+static uint8_t dataLamps = 0;
+static uint8_t controlLamp = 0;
+static uint16_t pendingButtonPresses = 0;
+
+static void readState(uint8_t *state) {
+    state[REMOTE_PANEL_FIELD_DATA_LAMPS] = dataLamps;
+    state[REMOTE_PANEL_FIELD_CONTROL_LAMP] = controlLamp;
+    state[REMOTE_PANEL_FIELD_OUTPUT] = memory[OUTPUT_REGISTER_ADDRESS];
+    state[REMOTE_PANEL_FIELD_P] = memory[P_REGISTER_ADDRESS];
+}
+
+static void start() {
+    uint8_t state[REMOTE_PANEL_FIELD_COUNT];
+    readState(state);
+
+    // A viewer that says hello again is still reading the same stream, so it has to get whole records
+    panelEncoderStart(state, active);
+    active = 1;
+}
+
+void remotePanelSetDataLamps(uint8_t value) {
+    dataLamps = value;
+}
+
+void remotePanelSetControlLamp(uint8_t lamp) {
+    controlLamp = lamp;
+}
+
+uint8_t remotePanelTakeButtonPress(uint8_t buttonIndex) {
+    uint16_t buttonBit = 1 << buttonIndex;
+    if (pendingButtonPresses & buttonBit) {
+        pendingButtonPresses &= ~buttonBit;
+        return 1;
+    }
+    return 0;
+}
+
+void remotePanelClearButtonPresses() {
+    pendingButtonPresses = 0;
+}
+
+void remotePanelUpdate() {
+    if (!active) {
+        return;
+    }
+
+    uint8_t state[REMOTE_PANEL_FIELD_COUNT];
+    readState(state);
+    panelEncoderUpdate(state);
+}
+
+void remotePanelPoll() {
+    int received;
+    while ((received = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (received == REMOTE_PANEL_HELLO) {
+            start();
+        }
+        else if (received == REMOTE_PANEL_BYE) {
+            active = 0;
+        }
+        // Ignore buttons until a viewer says hello, so typing in a terminal can't press them
+        else if (active && received < REMOTE_PANEL_BUTTON_COUNT) {
+            pendingButtonPresses |= 1 << received;
+        }
+    }
+}
+
+void remotePanelFlush() {
+    if (!active) {
+        return;
+    }
+
+    if (!stdio_usb_connected()) {
+        // The viewer went away. It has to say hello again to get a fresh keyframe.
+        active = 0;
+        return;
+    }
+
+    // At most two writes, one up to the end of the buffer and one for what wrapped around.
+    // Each is capped to what fits in the CDC FIFO, so this never waits for the host.
+    for (int segment = 0; segment < 2; ++segment) {
+        const uint8_t *data;
+        uint32_t length = panelEncoderPending(&data);
+        uint32_t space = tud_cdc_write_available();
+        if (length > space) {
+            length = space;
+        }
+        if (length == 0) {
+            break;
+        }
+
+        // Goes through the SDK's USB stdio driver, so it holds the same mutex as the background USB task
+        stdio_usb.out_chars((const char *)data, length);
+        panelEncoderConsume(length);
+    }
+}
+
+void remotePanelService() {
+    remotePanelPoll();
+    remotePanelUpdate();
+    remotePanelFlush();
+}
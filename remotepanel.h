@@ -0,0 +1,37 @@
+#include <stdint.h>
+
+#ifndef PICOKENBAK_REMOTEPANEL_H
+#define PICOKENBAK_REMOTEPANEL_H
+
+/*
+ * Remote front panel over USB CDC.
+ * Nothing is sent until a host viewer sends REMOTE_PANEL_HELLO, so a plain serial terminal is unaffected.
+ * See the README for the wire format.
+ */
+
+// Bytes the host sends to the board
+#define REMOTE_PANEL_HELLO 0x80
+#define REMOTE_PANEL_BYE 0x81
+// 0x00-0x0D press the button at that index of pushButtonPins in main()
+#define REMOTE_PANEL_BUTTON_COUNT 14
+#define REMOTE_PANEL_STOP_BUTTON_INDEX 9
+
+/*
+ * execute() samples the panel and services the link once every this many instructions, must be a power of 2.
+ * So a viewer only sees P as often as this. OUTPUT is sent whenever it changes, unless the host
+ * can't keep up and the buffer is full, then changes are merged into the next delta.
+ */
+#define REMOTE_PANEL_SERVICE_INTERVAL 256
+
+void remotePanelSetDataLamps(uint8_t value);
+void remotePanelSetControlLamp(uint8_t lamp);
+
+uint8_t remotePanelTakeButtonPress(uint8_t buttonIndex);
+void remotePanelClearButtonPresses();
+
+void remotePanelUpdate();
+
+void remotePanelPoll();
+void remotePanelFlush();
+void remotePanelService();
+#endif //PICOKENBAK_REMOTEPANEL_H